@@ -38,12 +38,15 @@
 #include <cmath>
 #include <iomanip>
 
+#include "instrumentation.h"
+
 const double x_0 = 2.0;
 const double y_0 = 0.0;
 const double z_0 = 2.0;
 
 int main()
 {
+    NM_PROFILE("Gauss-Seidel method");
 	
     double xi, yi, zi;
     double x_prev = 0, y_prev = 0, z_prev = 0;
@@ -68,12 +71,23 @@ int main()
             z_prev = zi;
 
             // precision[i] decimal places
-            xi = round( pow(10, precision[i]) * ((17 - yi + 2*zi)/20) ) / pow(10, precision[i]);
-            yi = round( pow(10, precision[i]) * ((-17 - 3*xi - zi)/20) ) / pow(10, precision[i]);
-            zi = round( pow(10, precision[i]) * ((25 - 2*xi + 3*yi)/20) ) / pow(10, precision[i]);
+            {
+                NM_SCOPED_TIMER("sweep");
+                xi = round( pow(10, precision[i]) * ((17 - yi + 2*zi)/20) ) / pow(10, precision[i]);
+                yi = round( pow(10, precision[i]) * ((-17 - 3*xi - zi)/20) ) / pow(10, precision[i]);
+                zi = round( pow(10, precision[i]) * ((25 - 2*xi + 3*yi)/20) ) / pow(10, precision[i]);
+            }
                     
             ++counter;
 
+            // a sweep does 9 additions and multiplications and 3 divisions, plus 3
+            // roundings (2 pow, 1 multiplication and 1 division each). The coefficients
+            // are literals and x, y, z scalars held in registers, so there is no memory
+            // traffic to count: this 3x3 example cannot show a bandwidth-bound sweep.
+            NM_COUNT(iterations, 1);
+            NM_COUNT(flops, 12 + 3 * 2);
+            NM_COUNT(transcendentals, 3 * 2);
+
             std::cout << "Iter #" << counter << ": " << std::fixed << std::setprecision(precision[i])
                 << "x_" << counter << " = " << xi << "  "
                 << "y_" << counter << " = " << yi << "  "
@@ -22,11 +22,25 @@
 #include <cmath>
 #include <iomanip>
 
+#include "instrumentation.h"
+
 const float x0 = 0.1;
 const float x00 = 0.203;
 
+// Instrumentation of an evaluation of the regression formula, rounded:
+// f and f' (2 exp), 11 flops and 2 pow
+inline void countRegression()
+{
+    NM_COUNT(f_evals, 1);
+    NM_COUNT(j_evals, 1);
+    NM_COUNT(transcendentals, 2 + 2);
+    NM_COUNT(flops, 11);
+}
+
 int main()
 {
+    NM_PROFILE("Newton-Raphson method");
+
     float xi, x_prev = 0;
     int counter = 0, precision[] = {2,3,6,12};
 
@@ -43,15 +57,24 @@ int main()
 
         while (x_prev != xi) {
             x_prev = xi;
+            NM_COUNT(iterations, 1);
 
             // In order not to print zero
-            if( !roundf( pow(10, precision[i]) * (xi - (exp(2*xi)-3*xi-1)/(2*exp(2*xi)-3)) )
-                / pow(10, precision[i]) )
-                break;
+            countRegression();
+            {
+                NM_SCOPED_TIMER("regression");
+                if( !roundf( pow(10, precision[i]) * (xi - (exp(2*xi)-3*xi-1)/(2*exp(2*xi)-3)) )
+                    / pow(10, precision[i]) )
+                    break;
+            }
 
             // precision[i] decimal places
-            xi = roundf( pow(10, precision[i]) * (xi - (exp(2*xi)-3*xi-1)/(2*exp(2*xi)-3)) )
-                / pow(10, precision[i]);
+            countRegression();
+            {
+                NM_SCOPED_TIMER("regression");
+                xi = roundf( pow(10, precision[i]) * (xi - (exp(2*xi)-3*xi-1)/(2*exp(2*xi)-3)) )
+                    / pow(10, precision[i]);
+            }
             ++counter;
             std::cout << std::setprecision(precision[i])
                 << "x_" << counter << " = " << xi << std::endl;
@@ -80,14 +103,23 @@ int main()
 
         while (x_prev != xi) {
             x_prev = xi;
-
-            if( !roundf( pow(10,precision[i]) * (xi - (exp(2*xi)-3*xi-1)/(2*exp(2*xi)-3)) )
-                / pow(10,precision[i]) )
-                break;
+            NM_COUNT(iterations, 1);
+
+            countRegression();
+            {
+                NM_SCOPED_TIMER("regression");
+                if( !roundf( pow(10,precision[i]) * (xi - (exp(2*xi)-3*xi-1)/(2*exp(2*xi)-3)) )
+                    / pow(10,precision[i]) )
+                    break;
+            }
             
             // precision[i] decimal places
-            xi = roundf( pow(10,precision[i]) * (xi - (exp(2*xi)-3*xi-1)/(2*exp(2*xi)-3)) )
-                / pow(10,precision[i]);
+            countRegression();
+            {
+                NM_SCOPED_TIMER("regression");
+                xi = roundf( pow(10,precision[i]) * (xi - (exp(2*xi)-3*xi-1)/(2*exp(2*xi)-3)) )
+                    / pow(10,precision[i]);
+            }
             ++counter;
             // std::cout << std::setprecision(precision[i])
             //     << "x_" << counter << " = " << xi << std::endl;
@@ -25,11 +25,15 @@
 #include <cmath>
 #include <iomanip>
 
+#include "instrumentation.h"
+
 const double x_0 = 1.5;
 const double y_0 = 0.8;
 
 int main()
 {
+    NM_PROFILE("Newton method | Simultaneous Equations");
+
     double xi;
     double yi;
     double x_prev = 0;
@@ -53,9 +57,18 @@ int main()
         while (x_prev != xi) {
             x_prev = xi;
             // precision[i] decimal places
-            xi = round( pow(10, precision[i]) * (xi - (4 * pow(xi, 2) - 11) / (8 * xi)) )
-                / pow(10, precision[i]);
+            {
+                NM_SCOPED_TIMER("regression x");
+                xi = round( pow(10, precision[i]) * (xi - (4 * pow(xi, 2) - 11) / (8 * xi)) )
+                    / pow(10, precision[i]);
+            }
             ++counter_x;
+            // f and f_x: 1 pow and 5 flops, rounding: 2 pow and 2 flops
+            NM_COUNT(iterations, 1);
+            NM_COUNT(f_evals, 1);
+            NM_COUNT(j_evals, 1);
+            NM_COUNT(transcendentals, 1 + 2);
+            NM_COUNT(flops, 5 + 2);
             std::cout << "x_" << counter_x << " = " << std::fixed
                 << std::setprecision(precision[i]) << xi << std::endl;
         }
@@ -68,9 +81,18 @@ int main()
         while (y_prev != yi) {
             y_prev = yi;
             // precision[i] decimal places
-            yi = round( pow(10, precision[i]) * (yi - (4 * pow(yi, 2) - 1) / (8 * yi)) )
-                / pow(10, precision[i]);
+            {
+                NM_SCOPED_TIMER("regression y");
+                yi = round( pow(10, precision[i]) * (yi - (4 * pow(yi, 2) - 1) / (8 * yi)) )
+                    / pow(10, precision[i]);
+            }
             ++counter_y;
+            // g and g_y: 1 pow and 5 flops, rounding: 2 pow and 2 flops
+            NM_COUNT(iterations, 1);
+            NM_COUNT(f_evals, 1);
+            NM_COUNT(j_evals, 1);
+            NM_COUNT(transcendentals, 1 + 2);
+            NM_COUNT(flops, 5 + 2);
             std::cout << std::setprecision(precision[i]) << "y_" << counter_y << " = "
                 << yi << std::endl;
         }		
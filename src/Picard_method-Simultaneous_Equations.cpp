@@ -30,11 +30,15 @@
 #include <cmath>
 #include <iomanip>
 
+#include "instrumentation.h"
+
 const double x_0 = 2.0;
 const double y_0 = 1.4;
 
 int main()
 {
+    NM_PROFILE("Picard method | Simultaneous equations");
+
     double xi;
     double yi;
     double x_prev = 0;
@@ -58,9 +62,17 @@ int main()
         while (x_prev != xi) {
             x_prev = xi;
             // precision[i] decimal places
-            xi = round( pow(10, precision[i]) * (sqrt(3 - pow(xi, 2))) )
-                / pow(10, precision[i]);
+            {
+                NM_SCOPED_TIMER("regression x");
+                xi = round( pow(10, precision[i]) * (sqrt(3 - pow(xi, 2))) )
+                    / pow(10, precision[i]);
+            }
             ++counter_x;
+            // f: 1 pow, 1 sqrt and 1 flop, rounding: 2 pow and 2 flops
+            NM_COUNT(iterations, 1);
+            NM_COUNT(f_evals, 1);
+            NM_COUNT(transcendentals, 2 + 2);
+            NM_COUNT(flops, 1 + 2);
             std::cout << std::fixed << std::setprecision(precision[i]) << "x_"
                 << counter_x << " = " << xi << std::endl;
         }
@@ -73,9 +85,17 @@ int main()
         while (counter_y < 10) {      //y_prev != yi
             y_prev = yi;
             // precision[i] decimal places
-            yi = round( pow(10, precision[i]) * (sqrt((pow(yi, 2) - 2) / 3)) )
-                / pow(10, precision[i]);
+            {
+                NM_SCOPED_TIMER("regression y");
+                yi = round( pow(10, precision[i]) * (sqrt((pow(yi, 2) - 2) / 3)) )
+                    / pow(10, precision[i]);
+            }
             ++counter_y;
+            // g: 1 pow, 1 sqrt and 2 flops, rounding: 2 pow and 2 flops
+            NM_COUNT(iterations, 1);
+            NM_COUNT(f_evals, 1);
+            NM_COUNT(transcendentals, 2 + 2);
+            NM_COUNT(flops, 2 + 2);
             std::cout << std::setprecision(precision[i]) << "y_" << counter_y
                 << " = " << yi << std::endl;
         }
@@ -22,10 +22,14 @@
 #include <cmath>
 #include <iomanip>
 
+#include "instrumentation.h"
+
 const float x0 = 0.1;
 
 int main()
 {
+    NM_PROFILE("Picard method");
+
     float xi, x_prev = 0;
     int counter = 0, precision[] = {2,3,6,12};
 
@@ -43,7 +47,15 @@ int main()
         while (x_prev != xi) {
             x_prev = xi;
             // precision[i] decimal places
-            xi = roundf(pow(10, precision[i]) * (exp(2*xi)-1)/3) / pow(10, precision[i]);
+            {
+                NM_SCOPED_TIMER("regression");
+                xi = roundf(pow(10, precision[i]) * (exp(2*xi)-1)/3) / pow(10, precision[i]);
+            }
+            // g: 1 exp and 3 flops, rounding: 2 pow and 2 flops
+            NM_COUNT(iterations, 1);
+            NM_COUNT(f_evals, 1);
+            NM_COUNT(transcendentals, 1 + 2);
+            NM_COUNT(flops, 3 + 2);
             //std::cout << std::fixed << std::setprecision(precision[i])
             //    << "x_" << counter << " = " << xi << std::endl;
             ++counter;
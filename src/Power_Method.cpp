@@ -29,6 +29,8 @@
 #include <algorithm>
 #include <memory>
 
+#include "instrumentation.h"
+
 //! N: dimension of the square matrix
 const int N = 6;
 
@@ -38,6 +40,8 @@ typedef std::vector< std::vector<size_t> > vector_int_2D;
 //! A function that returns a given power of a given square matrix
 vector_int_2D sqVectPow(vector_int_2D& inputSqVect, int power)
 {
+    NM_SCOPED_TIMER("sqVectPow");
+
     vector_int_2D newSqVect(inputSqVect);       // this will be eventually returned
     vector_int_2D tempSqVect(N, vector_int(N)); // this will hold the step-wise solution
 
@@ -57,6 +61,10 @@ vector_int_2D sqVectPow(vector_int_2D& inputSqVect, int power)
             }
         }
 
+        // N^3 multiply-adds, reading new and input and writing temp
+        NM_COUNT(flops, 2 * N * N * N);
+        NM_COUNT(bytes, 3 * N * N * sizeof(size_t));
+
         // newSqVect = tempSqVect
         // and tempSqVect = newSqVect, but tempSqVect will be set to zero
         newSqVect.swap(tempSqVect);
@@ -69,6 +77,8 @@ vector_int_2D sqVectPow(vector_int_2D& inputSqVect, int power)
 std::unique_ptr<vector_int> x_n(vector_int_2D&& poweredSqVect_input,
                                 vector_int& arbitrary_vector)
 {
+    NM_SCOPED_TIMER("x_n");
+
     std::unique_ptr<vector_int> x_n = std::make_unique<vector_int>(N);
 
     for (size_t i = 0; i < N; ++i) {
@@ -76,6 +86,11 @@ std::unique_ptr<vector_int> x_n(vector_int_2D&& poweredSqVect_input,
             (*x_n)[i] += poweredSqVect_input[i][j] * arbitrary_vector[j];
         }
     }
+
+    // N^2 multiply-adds, reading the matrix and x, writing x_n
+    NM_COUNT(flops, 2 * N * N);
+    NM_COUNT(bytes, (N * N + 2 * N) * sizeof(size_t));
+
     return x_n;
 }
 
@@ -88,6 +103,8 @@ double GreatestElement(std::unique_ptr<vector_int> x_n)
 
 int main()
 {
+    NM_PROFILE("Power Method");
+
     std::string title = "Power Method";
     std::cout << title << std::endl << std::string(title.length(), '-') << std::endl;
 
@@ -106,7 +123,8 @@ int main()
     int iter;
 
     //! greatest eigenvalue
-    double l;
+    //! (initialized != l_prev, so that the first regression block is entered)
+    double l = 1;
     double l_prev;
 
     int precision[] = {2, 3, 5};
@@ -125,6 +143,7 @@ int main()
 
             ++iter;
             l_prev = l;
+            NM_COUNT(iterations, 1);
 
             l = GreatestElement(x_n(sqVectPow(mySqVect, iter+1), x))
                 / GreatestElement(x_n(sqVectPow(mySqVect, iter), x));
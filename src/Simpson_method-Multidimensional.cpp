@@ -0,0 +1,588 @@
+/**
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/* Numerical algorithms | Numerical Integration | Multidimensional Simpson method
+ *
+ * This program extends the Simpson method to d-dimensional integrals over the
+ * unit hypercube [0, 1]^d. The intention is to compare the evaluations needed to
+ * reach a relative error of 1e-6, using:
+ *
+ * - the tensor product of the Simpson rule, with n points per dimension, which
+ *   needs n^d evaluations
+ *
+ * - Smolyak sparse grids, built on nested 1-D rules (Simpson or Clenshaw-Curtis)
+ *   of level j with 2^(j-1) + 1 points (1 point for j = 1):
+ *
+ *   Q_l = Σ (Δ_(i_1) ⊗ ... ⊗ Δ_(i_d)),   i_1 + ... + i_d <= l + d - 1
+ *
+ *   where Δ_j = Q_j - Q_(j-1) is the difference of two successive 1-D rules.
+ *   Since the rules are nested, every node is evaluated only once, with weight
+ *   the sum of the products of the differences of the 1-D weights.
+ *
+ * Test integrands: the oscillatory, product peak and gaussian families of Genz,
+ * whose integrals are known analytically.
+ *
+ * The nodes are never materialized; they are generated in chunks of chunk_nodes,
+ * sized to fit in the cache along with their weights, and the chunks are
+ * integrated in parallel. Each chunk sums into its own slot, and the slots are
+ * added in chunk order, so the result does not depend on the number of threads.
+ *
+ * g++ -O2 -pthread Simpson_method-Multidimensional.cpp
+ */
+
+#include <iostream>
+#include <cmath>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#include "instrumentation.h"
+
+// Maximum dimension of the test integrands
+const int max_dim = 8;
+
+// Nodes per chunk (x: 512 * 8 doubles and w: 512 doubles, ~36 KiB)
+const size_t chunk_nodes = 512;
+
+// Target relative error
+const double tolerance = 1e-6;
+
+// Refinement stops when a grid would need more evaluations than this
+const size_t max_evaluations = 50000000;
+
+// Parameters of the test integrands
+const double u[max_dim] = {0.30, 0.60, 0.45, 0.70, 0.35, 0.55, 0.65, 0.40};
+const double a_oscillatory[max_dim] = {0.9, 1.1, 0.7, 1.3, 0.8, 1.2, 1.0, 0.6};
+const double a_peak[max_dim] = {1.5, 1.2, 1.8, 1.0, 1.4, 1.6, 1.1, 1.3};
+const double a_gaussian[max_dim] = {1.2, 0.9, 1.4, 1.0, 1.1, 0.8, 1.3, 0.7};
+
+/* Genz oscillatory
+ * f(x) = cos(2πu_1 + Σ a_k x_k)
+ */
+double oscillatory(const double* x, int dim)
+{
+    double arg = 2 * M_PI * u[0];
+    for (int k = 0; k < dim; ++k)
+        arg += a_oscillatory[k] * x[k];
+    return cos(arg);
+}
+
+// Re[e^(i2πu_1) Π (e^(ia_k) - 1) / (ia_k)]
+double oscillatoryExact(int dim)
+{
+    std::complex<double> I = std::polar(1.0, 2 * M_PI * u[0]);
+    for (int k = 0; k < dim; ++k) {
+        I *= (std::polar(1.0, a_oscillatory[k]) - 1.0)
+            / std::complex<double>(0, a_oscillatory[k]);
+    }
+    return I.real();
+}
+
+/* Genz product peak
+ * f(x) = Π 1 / (a_k^-2 + (x_k - u_k)^2)
+ */
+double productPeak(const double* x, int dim)
+{
+    double f = 1;
+    for (int k = 0; k < dim; ++k)
+        f /= 1 / (a_peak[k] * a_peak[k]) + (x[k] - u[k]) * (x[k] - u[k]);
+    return f;
+}
+
+// Π a_k (atan(a_k (1 - u_k)) + atan(a_k u_k))
+double productPeakExact(int dim)
+{
+    double I = 1;
+    for (int k = 0; k < dim; ++k)
+        I *= a_peak[k] * (atan(a_peak[k] * (1 - u[k])) + atan(a_peak[k] * u[k]));
+    return I;
+}
+
+/* Genz gaussian
+ * f(x) = exp(-Σ a_k^2 (x_k - u_k)^2)
+ */
+double gaussian(const double* x, int dim)
+{
+    double arg = 0;
+    for (int k = 0; k < dim; ++k)
+        arg += a_gaussian[k] * a_gaussian[k] * (x[k] - u[k]) * (x[k] - u[k]);
+    return exp(-arg);
+}
+
+// Π √π / (2a_k) (erf(a_k (1 - u_k)) + erf(a_k u_k))
+double gaussianExact(int dim)
+{
+    double I = 1;
+    for (int k = 0; k < dim; ++k) {
+        I *= sqrt(M_PI) / (2 * a_gaussian[k])
+            * (erf(a_gaussian[k] * (1 - u[k])) + erf(a_gaussian[k] * u[k]));
+    }
+    return I;
+}
+
+typedef double (*Integrand)(const double* x, int dim);
+
+struct TestIntegrand
+{
+    const char* name;
+    Integrand f;
+    double (*exact)(int dim);
+    int flops;              // flops of an evaluation: flops + flops_per_dim * dim
+    int flops_per_dim;
+    int transcendentals;    // cos/exp calls of an evaluation
+};
+
+/* Weights of the composite Simpson rule on [0, 1] with the given (odd) points
+ * h/3 (1, 4, 2, 4, ..., 2, 4, 1)
+ */
+std::vector<double> simpsonWeights(int points)
+{
+    std::vector<double> w(points);
+    double h = 1.0 / (points - 1);
+
+    for (int i = 0; i < points; ++i)
+        w[i] = h / 3 * ((i == 0 || i == points - 1) ? 1 : (i % 2 ? 4 : 2));
+    return w;
+}
+
+/* Weights of the Clenshaw-Curtis rule on [0, 1] with the given (odd) points,
+ * located at x_k = (1 - cos(kπ/n)) / 2, where n = points - 1
+ *
+ * w_k = c_k / (2n) (1 - Σ_(j=1)^(n/2) b_j / (4j^2 - 1) cos(2jkπ/n))
+ *
+ * c_k = 1 for k = 0, n and 2 otherwise, b_j = 1 for j = n/2 and 2 otherwise
+ */
+std::vector<double> clenshawCurtisWeights(int points)
+{
+    std::vector<double> w(points);
+    int n = points - 1;
+
+    for (int k = 0; k <= n; ++k) {
+        double sum = 0;
+        for (int j = 1; j <= n / 2; ++j)
+            sum += (2 * j == n ? 1 : 2) / (4.0 * j * j - 1) * cos(2.0 * j * k * M_PI / n);
+        w[k] = (k == 0 || k == n ? 1 : 2) / (2.0 * n) * (1 - sum);
+    }
+    return w;
+}
+
+/* Tensor product of the Simpson rule
+ *
+ * points^dim nodes, the linear index of a node being its mixed-radix digits, the
+ * last dimension varying fastest.
+ */
+class TensorSimpsonGrid
+{
+public:
+    TensorSimpsonGrid(int dim, int points)
+        : dim_(dim), points_(points), w_(simpsonWeights(points)), size_(1)
+    {
+        for (int k = 0; k < dim; ++k)
+            size_ *= points;
+    }
+
+    int dim() const { return dim_; }
+    size_t size() const { return size_; }
+
+    //! Writes the coordinates (count x dim) and the weights (count) of the nodes
+    //! [begin, begin + count) into x and w
+    void generate(size_t begin, size_t count, double* x, double* w) const
+    {
+        std::vector<int> digit(dim_);
+        std::vector<double> prefix(dim_);    // prefix[k] = Π_(m<k) w(digit[m])
+
+        for (int k = dim_ - 1; k >= 0; --k) {
+            digit[k] = begin % points_;
+            begin /= points_;
+        }
+        updatePrefix(digit, prefix, 0);
+
+        const double h = 1.0 / (points_ - 1);
+        for (size_t n = 0; n < count; ++n, x += dim_) {
+            for (int k = 0; k < dim_; ++k)
+                x[k] = digit[k] * h;
+            w[n] = prefix[dim_ - 1] * w_[digit[dim_ - 1]];
+            if (n + 1 == count)
+                break;
+
+            // next node
+            int k = dim_ - 1;
+            while (k > 0 && ++digit[k] == points_)
+                digit[k--] = 0;
+            if (k == 0)
+                ++digit[0];
+            if (k < dim_ - 1)
+                updatePrefix(digit, prefix, k);
+        }
+    }
+
+private:
+    void updatePrefix(const std::vector<int>& digit, std::vector<double>& prefix,
+                      int from) const
+    {
+        prefix[0] = 1;
+        for (int k = std::max(from, 0); k < dim_ - 1; ++k)
+            prefix[k + 1] = prefix[k] * w_[digit[k]];
+    }
+
+    int dim_;
+    int points_;
+    std::vector<double> w_;
+    size_t size_;
+};
+
+enum Rule1D { Simpson, ClenshawCurtis };
+
+/* Smolyak sparse grid of a given level, built on a nested 1-D rule
+ *
+ * 1-D points are addressed by their index g on the finest grid of 2^(L-1) + 1
+ * points (L = max(level, 2)); level j >= 2 holds the points with g a multiple of
+ * 2^(L-j) and level 1 only the center. The nodes are grouped in blocks, one per
+ * multi-index i with |i| <= level + dim - 1, that hold the points first appearing
+ * at level i_k in each dimension. A node with levels i has weight
+ *
+ * W = Σ_(j >= i, |j| <= level + dim - 1) Π dw[j_k][g_k]
+ *
+ * where dw[j][g] is the difference of the weights of the 1-D rules j and j - 1.
+ * W is evaluated by a convolution over the dimensions, the prefix of which is
+ * kept while the nodes of a block are enumerated.
+ */
+class SmolyakGrid
+{
+public:
+    SmolyakGrid(int dim, int level, Rule1D rule)
+        : dim_(dim), level_(level), q_(level + dim - 1), size_(0)
+    {
+        buildRule(rule);
+
+        // blocks: every multi-index i >= 1 with |i| <= q, in lexicographic order
+        std::vector<int> i(dim_, 1);
+        int sum = dim_;
+        while (true) {
+            size_t nodes = 1;
+            for (int k = 0; k < dim_; ++k)
+                nodes *= new_points_[i[k]].size();
+            blocks_.insert(blocks_.end(), i.begin(), i.end());
+            offsets_.push_back(size_);
+            size_ += nodes;
+
+            int k = dim_ - 1;
+            while (k >= 0 && sum == q_) {
+                sum -= i[k] - 1;
+                i[k--] = 1;
+            }
+            if (k < 0)
+                break;
+            ++i[k];
+            ++sum;
+        }
+    }
+
+    int dim() const { return dim_; }
+    size_t size() const { return size_; }
+
+    //! Writes the coordinates (count x dim) and the weights (count) of the nodes
+    //! [begin, begin + count) into x and w
+    void generate(size_t begin, size_t count, double* x, double* w) const
+    {
+        const int stride = q_ + 1;
+        std::vector<int> digit(dim_);
+        std::vector<double> prefix(dim_ * stride);    // convolution of dims < k
+        std::vector<double> cumulative(stride);     // cumulative sum of the last
+
+        size_t block = std::upper_bound(offsets_.begin(), offsets_.end(), begin)
+            - offsets_.begin() - 1;
+        size_t local = begin - offsets_[block];
+        const int* i = &blocks_[block * dim_];
+
+        for (int k = dim_ - 1; k >= 0; --k) {
+            size_t radix = new_points_[i[k]].size();
+            digit[k] = local % radix;
+            local /= radix;
+        }
+        updatePrefix(i, digit, prefix, cumulative, 0);
+
+        for (size_t n = 0; n < count; ++n, x += dim_) {
+            for (int k = 0; k < dim_; ++k)
+                x[k] = x_[new_points_[i[k]][digit[k]]];
+
+            const int last = dim_ - 1;
+            const int g = new_points_[i[last]][digit[last]];
+            double weight = 0;
+            for (int j = i[last]; j <= level_; ++j)
+                weight += dw_[j][g] * cumulative[q_ - j];
+            w[n] = weight;
+            if (n + 1 == count)
+                break;
+
+            // next node, moving on to the next block when this one is exhausted
+            int k = last;
+            while (k >= 0 && ++digit[k] == (int)new_points_[i[k]].size())
+                digit[k--] = 0;
+            if (k < 0) {
+                i = &blocks_[++block * dim_];
+                k = 0;
+            }
+            if (k < last)
+                updatePrefix(i, digit, prefix, cumulative, k);
+        }
+    }
+
+private:
+    void buildRule(Rule1D rule)
+    {
+        const int finest = std::max(level_, 2);
+        const int m = (1 << (finest - 1)) + 1;
+        const int center = (m - 1) / 2;
+
+        x_.resize(m);
+        for (int g = 0; g < m; ++g) {
+            x_[g] = (rule == Simpson) ? (double)g / (m - 1)
+                                      : (1 - cos(g * M_PI / (m - 1))) / 2;
+        }
+
+        // weights of each level on the finest grid, 0 for the missing points
+        std::vector< std::vector<double> > weights(level_ + 1, std::vector<double>(m));
+        weights[1][center] = 1;
+        for (int j = 2; j <= level_; ++j) {
+            int points = (1 << (j - 1)) + 1;
+            int step = 1 << (finest - j);
+            std::vector<double> wj = (rule == Simpson) ? simpsonWeights(points)
+                                                       : clenshawCurtisWeights(points);
+            for (int p = 0; p < points; ++p)
+                weights[j][p * step] = wj[p];
+        }
+
+        dw_.assign(level_ + 1, std::vector<double>(m));
+        new_points_.assign(level_ + 1, std::vector<int>());
+        for (int j = 1; j <= level_; ++j) {
+            int step = (j == 1) ? 0 : 1 << (finest - j);
+            for (int g = 0; g < m; ++g) {
+                dw_[j][g] = weights[j][g] - weights[j - 1][g];
+
+                bool in_j = (j == 1) ? g == center : g % step == 0;
+                bool in_prev = (j == 1) ? false
+                    : (j == 2) ? g == center : g % (2 * step) == 0;
+                if (in_j && !in_prev)
+                    new_points_[j].push_back(g);
+            }
+        }
+    }
+
+    void updatePrefix(const int* i, const std::vector<int>& digit,
+                      std::vector<double>& prefix, std::vector<double>& cumulative,
+                      int from) const
+    {
+        const int stride = q_ + 1;
+
+        std::fill(prefix.begin(), prefix.begin() + stride, 0.0);
+        prefix[0] = 1;
+        for (int k = from; k < dim_ - 1; ++k) {
+            const double* in = &prefix[k * stride];
+            double* out = &prefix[(k + 1) * stride];
+            const int g = new_points_[i[k]][digit[k]];
+
+            std::fill(out, out + stride, 0.0);
+            for (int s = 0; s <= q_; ++s) {
+                if (in[s] == 0)
+                    continue;
+                for (int j = i[k]; j <= level_ && s + j <= q_; ++j)
+                    out[s + j] += in[s] * dw_[j][g];
+            }
+        }
+
+        const double* in = &prefix[(dim_ - 1) * stride];
+        cumulative[0] = in[0];
+        for (int s = 1; s <= q_; ++s)
+            cumulative[s] = cumulative[s - 1] + in[s];
+    }
+
+    int dim_;
+    int level_;
+    int q_;
+    std::vector<double> x_;                          // 1-D abscissae, by g
+    std::vector< std::vector<double> > dw_;          // dw_[j][g]
+    std::vector< std::vector<int> > new_points_;     // g first appearing at level j
+    std::vector<int> blocks_;                        // multi-indices, dim_ per block
+    std::vector<size_t> offsets_;                    // first node of each block
+    size_t size_;
+};
+
+/* Cubature
+ * returns Σ w_n f(x_n) over the nodes of the grid
+ *
+ * The chunks are handed out to the threads dynamically, but each one sums into
+ * partial[chunk] and the partial sums are added in chunk order.
+ */
+template <class Grid>
+double cubature(const Grid& grid, Integrand f)
+{
+    const int dim = grid.dim();
+    const size_t chunks = (grid.size() + chunk_nodes - 1) / chunk_nodes;
+    std::vector<double> partial(chunks);
+    std::atomic<size_t> next(0);
+
+    auto worker = [&]() {
+        std::vector<double> x(chunk_nodes * dim);
+        std::vector<double> w(chunk_nodes);
+
+        for (size_t c = next++; c < chunks; c = next++) {
+            size_t begin = c * chunk_nodes;
+            size_t count = std::min(chunk_nodes, grid.size() - begin);
+            grid.generate(begin, count, x.data(), w.data());
+
+            double sum = 0;
+            for (size_t n = 0; n < count; ++n)
+                sum += w[n] * f(&x[n * dim], dim);
+            partial[c] = sum;
+        }
+    };
+
+    unsigned n_threads = std::max(1u, std::thread::hardware_concurrency());
+    n_threads = std::min<size_t>(n_threads, chunks);
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < n_threads; ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& t : threads)
+        t.join();
+
+    double I = 0;
+    for (double p : partial)
+        I += p;
+    return I;
+}
+
+// Evaluates the relative error
+double relativeError(double I, double exact)
+{
+    return fabs(I - exact) / fabs(exact);
+}
+
+//! The outcome of a refinement, up to the tolerance or to max_evaluations
+struct Result
+{
+    bool converged;
+    int refinement;         // points per dimension or level
+    size_t evaluations;
+    double I;
+    double error;
+    double seconds;
+};
+
+/* Refines a grid, built by make_grid(r) for r = first, next(first), ..., until
+ * the relative error drops below tolerance, or the next grid would need more
+ * than max_evaluations.
+ */
+template <class MakeGrid, class Next>
+Result refine(const TestIntegrand& test, int dim, int first, Next next,
+              MakeGrid make_grid)
+{
+    const double exact = test.exact(dim);
+    Result result = {false, first, 0, 0, 0, 0};
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (int r = first; ; r = next(r)) {
+        auto grid = make_grid(r);
+        if (grid.size() > max_evaluations)
+            break;
+
+        NM_COUNT(iterations, 1);
+        result.refinement = r;
+        result.evaluations += grid.size();
+        {
+            NM_SCOPED_TIMER("cubature");
+            result.I = cubature(grid, test.f);
+        }
+
+        // counted after the join, in the thread that opened the profile; each node
+        // adds 2 flops to the weighted sum
+        NM_COUNT(f_evals, grid.size());
+        NM_COUNT(transcendentals, test.transcendentals * grid.size());
+        NM_COUNT(flops, (test.flops + test.flops_per_dim * dim + 2) * grid.size());
+
+        result.error = relativeError(result.I, exact);
+
+        if (result.error < tolerance) {
+            result.converged = true;
+            break;
+        }
+    }
+
+    result.seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void printResult(const char* method, const Result& result)
+{
+    std::cout << std::setw(18) << std::left << method << std::right
+        << std::setw(7) << result.refinement
+        << std::setw(14) << result.evaluations
+        << std::setw(14) << std::setprecision(8) << std::fixed << result.I
+        << std::setw(11) << std::setprecision(2) << std::scientific << result.error
+        << std::setw(11) << std::setprecision(3) << std::fixed << result.seconds
+        << (result.converged ? "" : "  (not reached)")
+        << std::endl;
+}
+
+int main()
+{
+    NM_PROFILE("Multidimensional Simpson method");
+
+    std::string title = "Multidimensional Numerical Integration using the Simpson method";
+    std::cout << title << std::endl << std::string(title.length(), '-') << std::endl;
+    std::cout << "Relative error tolerance: " << std::scientific << std::setprecision(0)
+        << tolerance << ", threads: " << std::thread::hardware_concurrency()
+        << std::endl;
+
+    // flops per evaluation: oscillatory 2 + 2d, product peak 7d, gaussian 1 + 6d
+    const TestIntegrand tests[] = {{"Oscillatory", oscillatory, oscillatoryExact, 2, 2, 1},
+                                   {"Product peak", productPeak, productPeakExact, 0, 7, 0},
+                                   {"Gaussian", gaussian, gaussianExact, 1, 6, 1}};
+    const int dims[] = {3, 5, 8};
+
+    /* Evaluations counts the nodes of all the grids of the refinement, since the
+     * error of a grid is not known in advance. Tensor Simpson doubles the
+     * intervals per dimension, so that n stays odd, and the sparse grids raise
+     * their level by one.
+     */
+    for (const TestIntegrand& test : tests) {
+        for (int dim : dims) {
+            std::cout << std::endl << test.name << ", d = " << dim << std::endl
+                << "Method            n/level   Evaluations      Integral"
+                << "      Error    Time(s)" << std::endl;
+
+            auto doubling = [](int points) { return 2 * points - 1; };
+            auto increment = [](int level) { return level + 1; };
+
+            printResult("Tensor Simpson",
+                        refine(test, dim, 3, doubling, [dim](int points) {
+                            return TensorSimpsonGrid(dim, points); }));
+            printResult("Smolyak Simpson",
+                        refine(test, dim, 1, increment, [dim](int level) {
+                            return SmolyakGrid(dim, level, Simpson); }));
+            printResult("Smolyak C-C",
+                        refine(test, dim, 1, increment, [dim](int level) {
+                            return SmolyakGrid(dim, level, ClenshawCurtis); }));
+        }
+    }
+}
@@ -31,6 +31,8 @@
 #include <iomanip>
 #include <ctime>
 
+#include "instrumentation.h"
+
 // The integration range (b - a = 4π)
 const double range = 4 * M_PI;
 
@@ -58,6 +60,8 @@ double h(int points)
  */
 double simpsonMethod(int points)
 {
+    NM_SCOPED_TIMER("simpsonMethod");
+
     // Initialize sum with f(a) + f(b)
     double sum = f_a + f_b;
 
@@ -70,6 +74,13 @@ double simpsonMethod(int points)
         }
     }
 
+    // each interior node: f (exp, sin and 3 flops), plus h(), the abscissa, the
+    // weight and the accumulation (5 flops); the nodes are generated and the sum
+    // is a scalar, so there is no memory traffic to count
+    NM_COUNT(f_evals, points - 2);
+    NM_COUNT(transcendentals, 2 * (points - 2));
+    NM_COUNT(flops, (3 + 5) * (points - 2));
+
     // Evaluation of the integral, rounding at a given precision
     double I = round((h(points) / 3 * sum) * pow(10, precision)) / pow(10, precision);
 
@@ -84,6 +95,8 @@ double residual(double prev, double current)
 
 int main()
 {
+    NM_PROFILE("Simpson method");
+
     std::string title = "Numerical Integration using the Simpson method";
     std::cout << title << std::endl << std::string(title.length(), '-') << std::endl;
 
@@ -106,6 +119,7 @@ int main()
 
         ++iter;
         I_prev = I;
+        NM_COUNT(iterations, 1);
         I = simpsonMethod(points);
 
         // Every 15 lines, print the titles.
@@ -0,0 +1,480 @@
+/**
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/* Numerical algorithms | Instrumentation
+ *
+ * A header-only instrumentation layer, shared by the C++ programs, that tells
+ * where the time of a solver goes. It is compiled out, unless the program is
+ * built with -DNM_INSTRUMENT, eg:
+ *
+ *     g++ -O2 -DNM_INSTRUMENT Gauss-Seidel_method.cpp -o gauss_seidel
+ *
+ * NM_PROFILE(name)          opens the profile of a solver for the enclosing
+ *                           scope and prints its summary when the scope exits
+ * NM_COUNT(counter, n)      adds n to a counter of the active profile:
+ *                           iterations, f_evals, j_evals, transcendentals
+ *                           (pow/exp/sin/sqrt calls), flops, bytes
+ * NM_SCOPED_TIMER(label)    accumulates the wall time of the enclosing scope
+ *                           under label; the outermost timers make up the kernel
+ *                           time of the profile
+ *
+ * flops and bytes are counted by hand at the call site: flops are the arithmetic
+ * operations of a kernel (integer kernels count theirs as flops too) and bytes its
+ * compulsory traffic, ie every operand array loaded or stored once per call, as in
+ * the roofline model. Operands held in registers (scalars, literals) are not
+ * traffic. The summary reports the achieved GFLOP/s and GB/s over the kernel time,
+ * so a profile without timers reports no rates. When bytes are counted, it also
+ * reports the arithmetic intensity (flops/byte), which, compared to the ridge point
+ * of the roofline (peak GFLOP/s / peak GB/s), tells compute-bound kernels from
+ * bandwidth-bound ones; kernels within ridge_margin of the ridge get no verdict.
+ *
+ * The solvers are scalar and single-threaded, so the roofline is the one of a
+ * single core: the peaks are measured once, by a scalar multiply-add loop and a
+ * STREAM-like triad on one core, unless they are given by the NM_PEAK_GFLOPS and
+ * NM_PEAK_GBS environment variables. They are not the peaks of the machine, which
+ * SIMD, FMA and the rest of the cores raise by an order of magnitude or more.
+ * Like the kernels they rate, they are only meaningful in optimized (-O2) builds.
+ *
+ * The active profile is per thread: NM_COUNT and NM_SCOPED_TIMER only reach a
+ * profile opened by the same thread, and are no-ops on the others. Threaded code
+ * should count in the thread that opened the profile, eg after joining.
+ *
+ * On Linux, the cycles, instructions and LLC misses of the profiled scope are
+ * read via perf_event_open. If the kernel does not allow it (see
+ * /proc/sys/kernel/perf_event_paranoid), or if the program is built with
+ * -DNM_NO_PERF_EVENT, the hardware counters are just omitted from the summary.
+ */
+
+#ifndef NM_INSTRUMENTATION_H
+#define NM_INSTRUMENTATION_H
+
+#ifdef NM_INSTRUMENT
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+#if defined(__linux__) && !defined(NM_NO_PERF_EVENT)
+#define NM_HAVE_PERF_EVENT
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace instr {
+
+typedef std::chrono::steady_clock clock_type;
+
+//! Seconds elapsed since a given time point
+inline double secondsSince(clock_type::time_point start)
+{
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+/* Hardware counters
+ *
+ * cycles, instructions and LLC misses of the calling thread, opened as a single
+ * perf_event group, so that all three are scheduled on the PMU together.
+ */
+class HwCounters
+{
+public:
+    static const int n_events = 3;
+
+    HwCounters()
+    {
+#ifdef NM_HAVE_PERF_EVENT
+        const uint64_t configs[n_events] = {PERF_COUNT_HW_CPU_CYCLES,
+                                            PERF_COUNT_HW_INSTRUCTIONS,
+                                            PERF_COUNT_HW_CACHE_MISSES};
+        for (int i = 0; i < n_events; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.disabled = (i == 0);
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+
+            fd_[i] = syscall(__NR_perf_event_open, &attr, 0, -1, i ? fd_[0] : -1, 0);
+            if (fd_[i] < 0) {
+                close();
+                return;
+            }
+        }
+        ioctl(fd_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fd_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    ~HwCounters() { close(); }
+
+    HwCounters(const HwCounters&) = delete;
+    HwCounters& operator=(const HwCounters&) = delete;
+
+    bool available() const { return fd_[0] >= 0; }
+
+    //! Stops counting and stores the values into values[]
+    //! returns false if the counters are not available
+    bool stop(uint64_t values[n_events])
+    {
+#ifdef NM_HAVE_PERF_EVENT
+        if (!available())
+            return false;
+
+        ioctl(fd_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        // PERF_FORMAT_GROUP layout: nr, values[nr]
+        uint64_t buffer[1 + n_events];
+        if (read(fd_[0], buffer, sizeof(buffer)) != (ssize_t)sizeof(buffer)
+            || buffer[0] != n_events)
+            return false;
+
+        for (int i = 0; i < n_events; ++i)
+            values[i] = buffer[1 + i];
+        return true;
+#else
+        (void)values;
+        return false;
+#endif
+    }
+
+private:
+    void close()
+    {
+#ifdef NM_HAVE_PERF_EVENT
+        for (int i = n_events - 1; i >= 0; --i) {
+            if (fd_[i] >= 0)
+                ::close(fd_[i]);
+            fd_[i] = -1;
+        }
+#endif
+    }
+
+    int fd_[n_events] = {-1, -1, -1};
+};
+
+//! Relative distance from the ridge point, within which the peaks measured on a
+//! busy machine cannot tell compute-bound kernels from bandwidth-bound ones
+const double ridge_margin = 0.25;
+
+//! Scalar single-core peak performance
+struct Peak
+{
+    double gflops;
+    double gbs;
+};
+
+// Keeps a double in a floating point register, opaque to the optimizer, so
+// that the chains below are neither vectorized nor spilled to the stack
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NM_FP_REGISTER(v) asm volatile("" : "+x"(v))
+#elif defined(__GNUC__) && defined(__aarch64__)
+#define NM_FP_REGISTER(v) asm volatile("" : "+w"(v))
+#else
+#define NM_FP_REGISTER(v) ((void)0)
+#endif
+
+/* Measures the scalar multiply-add throughput of one core, using 8 independent
+ * chains held in registers, in order to hide the latency of the FPU.
+ */
+inline double measurePeakGflops()
+{
+    const long reps = 20000000;
+    volatile double seed = 1.0;
+    double a0 = seed, a1 = seed + 1, a2 = seed + 2, a3 = seed + 3;
+    double a4 = seed + 4, a5 = seed + 5, a6 = seed + 6, a7 = seed + 7;
+    const double m = 0.999999, c = 1e-7;
+
+    clock_type::time_point start = clock_type::now();
+    for (long r = 0; r < reps; ++r) {
+        a0 = a0 * m + c;
+        a1 = a1 * m + c;
+        a2 = a2 * m + c;
+        a3 = a3 * m + c;
+        a4 = a4 * m + c;
+        a5 = a5 * m + c;
+        a6 = a6 * m + c;
+        a7 = a7 * m + c;
+        NM_FP_REGISTER(a0);
+        NM_FP_REGISTER(a1);
+        NM_FP_REGISTER(a2);
+        NM_FP_REGISTER(a3);
+        NM_FP_REGISTER(a4);
+        NM_FP_REGISTER(a5);
+        NM_FP_REGISTER(a6);
+        NM_FP_REGISTER(a7);
+    }
+    double seconds = secondsSince(start);
+
+    // consume the result, so that the loop is not optimized away
+    seed = a0 + a1 + a2 + a3 + a4 + a5 + a6 + a7;
+
+    return 2.0 * 8 * reps / seconds * 1e-9;
+}
+
+/* Measures the memory bandwidth of one core with a STREAM-like triad,
+ * a[i] = b[i] + s * c[i], over arrays much larger than the last level cache.
+ */
+inline double measurePeakGbs()
+{
+    const size_t n = 1 << 23;     // 3 x 64 MiB
+    const int reps = 5;
+    std::vector<double> a(n, 0.0), b(n, 1.0), c(n, 2.0);
+    double best = 0;
+
+    for (int r = 0; r < reps; ++r) {
+        clock_type::time_point start = clock_type::now();
+        for (size_t i = 0; i < n; ++i)
+            a[i] = b[i] + 3.0 * c[i];
+        double seconds = secondsSince(start);
+
+        // 2 loads and 1 store per element
+        double gbs = 3.0 * sizeof(double) * n / seconds * 1e-9;
+        if (gbs > best)
+            best = gbs;
+    }
+    volatile double sink = a[n / 2];
+    (void)sink;
+
+    return best;
+}
+
+//! Returns the scalar single-core peak, measuring it on the first call
+inline const Peak& peak()
+{
+    static const Peak p = [] {
+        Peak result;
+        const char* gflops = std::getenv("NM_PEAK_GFLOPS");
+        const char* gbs = std::getenv("NM_PEAK_GBS");
+        result.gflops = gflops ? std::atof(gflops) : measurePeakGflops();
+        result.gbs = gbs ? std::atof(gbs) : measurePeakGbs();
+        return result;
+    }();
+    return p;
+}
+
+/* Profile of a solver
+ *
+ * Holds the counters and the timers of a solver, for the lifetime of the
+ * object, and prints a summary at destruction. Profiles can be nested; the
+ * counters always refer to the innermost one.
+ */
+class Profile
+{
+public:
+    uint64_t iterations = 0;
+    uint64_t f_evals = 0;
+    uint64_t j_evals = 0;
+    uint64_t transcendentals = 0;
+    uint64_t flops = 0;
+    uint64_t bytes = 0;
+
+    explicit Profile(const char* name)
+        : name_(name), parent_(current()), start_(clock_type::now())
+    {
+        current() = this;
+    }
+
+    ~Profile()
+    {
+        uint64_t hw[HwCounters::n_events];
+        bool hw_ok = hw_.stop(hw);
+        double seconds = secondsSince(start_);
+        current() = parent_;
+        report(seconds, hw_ok ? hw : nullptr);
+    }
+
+    Profile(const Profile&) = delete;
+    Profile& operator=(const Profile&) = delete;
+
+    //! The innermost active profile of the calling thread (nullptr if there is none)
+    static Profile*& current()
+    {
+        static thread_local Profile* p = nullptr;
+        return p;
+    }
+
+    //! Marks the start of a timer
+    void startTimer() { ++timer_depth_; }
+
+    //! Adds seconds to the timer labeled label, and to the kernel time if the
+    //! timer is not nested in another one
+    void addTime(const char* label, double seconds)
+    {
+        if (--timer_depth_ == 0)
+            kernel_seconds_ += seconds;
+
+        // few labels per solver, so a linear search beats a map
+        for (auto& t : timers_) {
+            if (t.label == label) {
+                t.seconds += seconds;
+                ++t.calls;
+                return;
+            }
+        }
+        timers_.push_back({label, seconds, 1});
+    }
+
+private:
+    struct Timer
+    {
+        const char* label;
+        double seconds;
+        uint64_t calls;
+    };
+
+    void report(double seconds, const uint64_t* hw) const
+    {
+        std::ostream& out = std::cerr;
+        std::ios_base::fmtflags flags = out.flags();
+        std::streamsize prec = out.precision();
+
+        std::string title = std::string("Profile | ") + name_;
+        out << std::endl << title << std::endl << std::string(title.length(), '-')
+            << std::endl << std::setprecision(6) << std::fixed
+            << "Time(s):          " << seconds << std::endl
+            << "Iterations:       " << iterations << std::endl
+            << "f evaluations:    " << f_evals << std::endl
+            << "J evaluations:    " << j_evals << std::endl
+            << "pow/exp calls:    " << transcendentals << std::endl
+            << "Flops:            " << flops << std::endl
+            << "Bytes:            " << bytes << std::endl;
+
+        for (const auto& t : timers_) {
+            out << "  [" << t.label << "] " << t.seconds << " s in " << t.calls
+                << " calls" << std::endl;
+        }
+
+        if (hw) {
+            out << "Cycles:           " << hw[0] << std::endl
+                << "Instructions:     " << hw[1] << "  (IPC "
+                << std::setprecision(2) << (hw[0] ? (double)hw[1] / hw[0] : 0.0)
+                << ")" << std::endl
+                << "LLC misses:       " << hw[2] << std::endl;
+        }
+        else {
+            out << "Hardware counters: not available" << std::endl;
+        }
+
+        if (!(flops || bytes)) {
+            // nothing to rate
+        }
+        else if (kernel_seconds_ <= 0) {
+            out << "GFLOP/s, GB/s:    n/a (no kernel timers)" << std::endl;
+        }
+        else {
+            const Peak& p = peak();
+            double gflops = flops / kernel_seconds_ * 1e-9;
+            double gbs = bytes / kernel_seconds_ * 1e-9;
+
+            out << std::setprecision(6)
+                << "Kernel time(s):   " << kernel_seconds_ << std::endl
+                << std::setprecision(3)
+                << "GFLOP/s:          " << gflops << "  (" << 100 * gflops / p.gflops
+                << "% of scalar single-core peak " << p.gflops << ")" << std::endl
+                << "GB/s:             " << gbs << "  (" << 100 * gbs / p.gbs
+                << "% of single-core triad " << p.gbs << ")" << std::endl;
+
+            if (bytes) {
+                double intensity = (double)flops / bytes;
+                double ridge = p.gflops / p.gbs;
+                out << "Intensity:        " << intensity << " flops/byte (single-core ridge "
+                    << ridge << ") -> ";
+                if (intensity < ridge * (1 - ridge_margin))
+                    out << "bandwidth-bound";
+                else if (intensity > ridge * (1 + ridge_margin))
+                    out << "compute-bound";
+                else
+                    out << "near the ridge, no verdict";
+                out << std::endl;
+            }
+            else {
+                out << "Intensity:        n/a (no memory traffic counted)" << std::endl;
+            }
+        }
+
+        out.flags(flags);
+        out.precision(prec);
+    }
+
+    const char* name_;
+    Profile* parent_;
+    clock_type::time_point start_;
+    std::vector<Timer> timers_;
+    int timer_depth_ = 0;
+    double kernel_seconds_ = 0;
+    HwCounters hw_;
+};
+
+//! Accumulates the wall time of its scope into the active profile
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(const char* label)
+        : label_(label), profile_(Profile::current())
+    {
+        if (profile_)
+            profile_->startTimer();
+        start_ = clock_type::now();
+    }
+
+    ~ScopedTimer()
+    {
+        if (profile_)
+            profile_->addTime(label_, secondsSince(start_));
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    const char* label_;
+    Profile* profile_;
+    clock_type::time_point start_;
+};
+
+} // namespace instr
+
+#define NM_CONCAT_(a, b) a##b
+#define NM_CONCAT(a, b) NM_CONCAT_(a, b)
+
+#define NM_PROFILE(name) instr::Profile NM_CONCAT(nm_profile_, __LINE__)(name)
+#define NM_COUNT(counter, n)                                       \
+    do {                                                           \
+        if (instr::Profile* nm_p_ = instr::Profile::current())     \
+            nm_p_->counter += (n);                                 \
+    } while (0)
+#define NM_SCOPED_TIMER(label) \
+    instr::ScopedTimer NM_CONCAT(nm_timer_, __LINE__)(label)
+
+#else // NM_INSTRUMENT
+
+#define NM_PROFILE(name) ((void)0)
+#define NM_COUNT(counter, n) ((void)0)
+#define NM_SCOPED_TIMER(label) ((void)0)
+
+#endif // NM_INSTRUMENT
+
+#endif // NM_INSTRUMENTATION_H